@@ -10,24 +10,51 @@
 #define CONFIG_MAX_ENTRIES 32
 #endif
 
+#ifdef STATIC_MEMORY
+#ifndef CONFIG_MAX_KEY
+#define CONFIG_MAX_KEY 64
+#endif
+typedef struct {
+    char key[CONFIG_MAX_KEY];
+    char value[CONFIG_MAX_STRING];
+} config_entry_t;
+#else
 typedef struct {
     char *key;
     char *value;
 } config_entry_t;
+#endif
 
 config_entry_t config_entries[CONFIG_MAX_ENTRIES];
 int config_entry_count = 0;
 
+#ifdef STATIC_MEMORY
+void __config_copy(char *dest, const size_t size, const char *src, const char *key) {
+    if (strlen(src) >= size)
+        fprintf(stderr, "config: '%s' exceeds %zu bytes, truncating\n", key, size - 1);
+    snprintf(dest, size, "%s", src);
+}
+#endif
+
 void __config_set_value(const char *key, const char *value) {
     for (int i = 0; i < config_entry_count; i++)
         if (strcmp(config_entries[i].key, key) == 0) {
+#ifdef STATIC_MEMORY
+            __config_copy(config_entries[i].value, sizeof(config_entries[i].value), value, key);
+#else
             free(config_entries[i].value);
             config_entries[i].value = strdup(value);
+#endif
             return;
         }
     if (config_entry_count < CONFIG_MAX_ENTRIES) {
+#ifdef STATIC_MEMORY
+        __config_copy(config_entries[config_entry_count].key, sizeof(config_entries[config_entry_count].key), key, key);
+        __config_copy(config_entries[config_entry_count].value, sizeof(config_entries[config_entry_count].value), value, key);
+#else
         config_entries[config_entry_count].key = strdup(key);
         config_entries[config_entry_count].value = strdup(value);
+#endif
         config_entry_count++;
     } else
         fprintf(stderr, "config: too many entries, ignoring %s=%s\n", key, value);
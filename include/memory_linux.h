@@ -0,0 +1,126 @@
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+// resident set size from /proc/self/statm, read without stdio so that it is safe to call from an allocation-free loop
+long memory_rss_kb(void) {
+    char buffer[128];
+    const int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd < 0)
+        return -1;
+    const ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= 0)
+        return -1;
+    buffer[length] = '\0';
+    char *next;
+    strtol(buffer, &next, 10); // size
+    const long resident = strtol(next, NULL, 10);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+// in STATIC_MEMORY builds the allocator is interposed to count allocations made on behalf of a scope: the caller marks its thread as in
+// the steady-state loop (MEMORY_SCOPE_LOOP), or as inside a library it cannot constrain (MEMORY_SCOPE_LIBRARY); other threads and
+// startup/recovery are untracked; the whole malloc family is covered, but not memory obtained by mmap/brk directly, nor allocations
+// glibc makes internally through its private entry points rather than the exported symbols
+
+typedef enum {
+    MEMORY_SCOPE_NONE = 0,
+    MEMORY_SCOPE_LOOP,
+    MEMORY_SCOPE_LIBRARY,
+    MEMORY_SCOPE_COUNT
+} memory_scope_t;
+
+#ifdef STATIC_MEMORY
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+
+_Thread_local memory_scope_t memory_scope = MEMORY_SCOPE_NONE;
+unsigned long memory_allocations[MEMORY_SCOPE_COUNT] = { 0 };
+
+void __memory_count(void) {
+    if (memory_scope != MEMORY_SCOPE_NONE)
+        __atomic_add_fetch(&memory_allocations[memory_scope], 1, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+    __memory_count();
+    return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) {
+    __memory_count();
+    return __libc_calloc(count, size);
+}
+void *realloc(void *pointer, size_t size) {
+    __memory_count();
+    return __libc_realloc(pointer, size);
+}
+void *reallocarray(void *pointer, size_t count, size_t size) {
+    size_t total;
+    __memory_count();
+    if (__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return __libc_realloc(pointer, total);
+}
+void *memalign(size_t alignment, size_t size) {
+    __memory_count();
+    return __libc_memalign(alignment, size);
+}
+void *aligned_alloc(size_t alignment, size_t size) {
+    __memory_count();
+    return __libc_memalign(alignment, size);
+}
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+    __memory_count();
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void *result = __libc_memalign(alignment, size);
+    if (result == NULL)
+        return ENOMEM;
+    *pointer = result;
+    return 0;
+}
+void *valloc(size_t size) {
+    __memory_count();
+    return __libc_valloc(size);
+}
+void *pvalloc(size_t size) {
+    __memory_count();
+    return __libc_pvalloc(size);
+}
+
+memory_scope_t memory_scope_set(const memory_scope_t scope) {
+    const memory_scope_t previous = memory_scope;
+    memory_scope = scope;
+    return previous;
+}
+
+unsigned long memory_allocations_get(const memory_scope_t scope) { return __atomic_load_n(&memory_allocations[scope], __ATOMIC_RELAXED); }
+
+#else
+
+memory_scope_t memory_scope_set(const memory_scope_t scope __attribute__((unused))) { return MEMORY_SCOPE_NONE; }
+
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
@@ -36,6 +36,25 @@ typedef struct {
 bool mosq_debug = false;
 struct mosquitto *mosq = NULL;
 mqtt_callback_data *mosq_callback_data = NULL;
+#ifdef STATIC_MEMORY
+mqtt_callback_data mosq_callback_data_static;
+#endif
+
+mqtt_callback_data *__mqtt_callback_data_alloc(void) {
+#ifdef STATIC_MEMORY
+    return &mosq_callback_data_static;
+#else
+    return malloc(sizeof(mqtt_callback_data));
+#endif
+}
+
+void __mqtt_callback_data_free(mqtt_callback_data *data) {
+#ifdef STATIC_MEMORY
+    (void)data;
+#else
+    free(data);
+#endif
+}
 
 bool mqtt_parse(const char *string, char *host, const int length, int *port, bool *ssl) {
     host[0] = '\0';
@@ -108,12 +127,13 @@ bool mqtt_begin(const MqttConfig *config) {
 
 void mqtt_end(void) {
     if (mosq_callback_data) {
-        free(mosq_callback_data);
+        __mqtt_callback_data_free(mosq_callback_data);
         mosq_callback_data = NULL;
     }
     if (mosq) {
-        mosquitto_loop_stop(mosq, true);
+        // disconnect is queued behind outstanding publishes, so the loop drains them before it exits
         mosquitto_disconnect(mosq);
+        mosquitto_loop_stop(mosq, false);
         mosquitto_destroy(mosq);
         mosq = NULL;
     }
@@ -123,14 +143,19 @@ void mqtt_end(void) {
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
-void mqtt_send(const char *topic, const char *message, const int length) {
+bool mqtt_publish(const char *topic, const char *message, const int length, const bool retain) {
     if (!mosq)
-        return;
-    const int result = mosquitto_publish(mosq, NULL, topic, length, message, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN);
-    if (result != MOSQ_ERR_SUCCESS)
+        return false;
+    const int result = mosquitto_publish(mosq, NULL, topic, length, message, MQTT_PUBLISH_QOS, retain);
+    if (result != MOSQ_ERR_SUCCESS) {
         fprintf(stderr, "mqtt: publish error: %s\n", mosquitto_strerror(result));
+        return false;
+    }
+    return true;
 }
 
+void mqtt_send(const char *topic, const char *message, const int length) { mqtt_publish(topic, message, length, MQTT_PUBLISH_RETAIN); }
+
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
@@ -173,8 +198,8 @@ bool mqtt_message_callback_register(void (*message_processor)(const char *)) {
     if (!mosq)
         return false;
     if (mosq_callback_data)
-        free(mosq_callback_data);
-    mosq_callback_data = malloc(sizeof(mqtt_callback_data));
+        __mqtt_callback_data_free(mosq_callback_data);
+    mosq_callback_data = __mqtt_callback_data_alloc();
     if (!mosq_callback_data) {
         fprintf(stderr, "mqtt: failed to allocate memory for callback data\n");
         return false;
@@ -191,7 +216,7 @@ void mqtt_message_callback_cancel(void) {
         return;
     mosquitto_user_data_set(mosq, NULL);
     if (mosq_callback_data) {
-        free(mosq_callback_data);
+        __mqtt_callback_data_free(mosq_callback_data);
         mosq_callback_data = NULL;
     }
     mosquitto_message_callback_set(mosq, NULL);
@@ -0,0 +1,87 @@
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+// saturation vapour pressure over water (Magnus/Sonntag: 6.112 * exp(17.62 T / (243.12 + T)) hPa) tabulated per half degree across the
+// sensor range, and ln() tabulated over the float mantissa, both at startup: per-sample derivations are interpolations, not expf/logf
+
+#define PSYCHRO_MAGNUS_E0 6.112f
+#define PSYCHRO_MAGNUS_A 17.62f
+#define PSYCHRO_MAGNUS_B 243.12f
+
+#define PSYCHRO_TABLE_MIN -40
+#define PSYCHRO_TABLE_MAX 125
+#define PSYCHRO_TABLE_STEPS 2 // per degree
+#define PSYCHRO_TABLE_SIZE ((PSYCHRO_TABLE_MAX - PSYCHRO_TABLE_MIN) * PSYCHRO_TABLE_STEPS + 1)
+#define PSYCHRO_LOG_BITS 8
+#define PSYCHRO_LOG_SIZE ((1 << PSYCHRO_LOG_BITS) + 1)
+#define PSYCHRO_VAPOUR_MIN 0.001f // hPa, floors dew point at about -80C
+
+float psychro_table[PSYCHRO_TABLE_SIZE];
+float psychro_log_table[PSYCHRO_LOG_SIZE];
+
+bool psychro_begin(void) {
+    for (int i = 0; i < PSYCHRO_TABLE_SIZE; i++) {
+        const float t = (float)PSYCHRO_TABLE_MIN + (float)i / (float)PSYCHRO_TABLE_STEPS;
+        psychro_table[i] = PSYCHRO_MAGNUS_E0 * expf(PSYCHRO_MAGNUS_A * t / (PSYCHRO_MAGNUS_B + t));
+    }
+    for (int i = 0; i < PSYCHRO_LOG_SIZE; i++)
+        psychro_log_table[i] = logf(1.0f + (float)i / (float)(1 << PSYCHRO_LOG_BITS));
+    return true;
+}
+
+float psychro_saturation(const float temperature) {
+    const float x = (temperature - (float)PSYCHRO_TABLE_MIN) * (float)PSYCHRO_TABLE_STEPS;
+    if (x <= 0.0f)
+        return psychro_table[0];
+    if (x >= (float)(PSYCHRO_TABLE_SIZE - 1))
+        return psychro_table[PSYCHRO_TABLE_SIZE - 1];
+    const int i = (int)x;
+    return psychro_table[i] + (x - (float)i) * (psychro_table[i + 1] - psychro_table[i]);
+}
+
+float psychro_log(const float value) { // positive, normal
+    union {
+        float f;
+        uint32_t i;
+    } u = { .f = value };
+    const int exponent = (int)((u.i >> 23) & 0xFF) - 127;
+    const uint32_t mantissa = u.i & 0x7FFFFF, index = mantissa >> (23 - PSYCHRO_LOG_BITS);
+    const float fraction = (float)(mantissa & ((1u << (23 - PSYCHRO_LOG_BITS)) - 1)) / (float)(1u << (23 - PSYCHRO_LOG_BITS));
+    return (float)exponent * 0.69314718f + psychro_log_table[index] + fraction * (psychro_log_table[index + 1] - psychro_log_table[index]);
+}
+
+float psychro_dewpoint(const float vapour) {
+    const float gamma = psychro_log((vapour > PSYCHRO_VAPOUR_MIN ? vapour : PSYCHRO_VAPOUR_MIN) / PSYCHRO_MAGNUS_E0);
+    return PSYCHRO_MAGNUS_B * gamma / (PSYCHRO_MAGNUS_A - gamma);
+}
+
+float psychro_absolute(const float temperature, const float vapour) { return 216.7f * vapour / (temperature + 273.15f); } // g/m3
+
+// NWS heat index, evaluated in Fahrenheit: the Steadman simple form, replaced by the Rothfusz regression (with its low and high humidity
+// adjustments) when the simple form averaged with the air temperature reaches 80F; as a deliberate deviation from NWS the result is
+// never less than the air temperature, as the simple form falls below it in cool air and consumers read it as a "feels like" value
+float psychro_heatindex(const float temperature, const float humidity) {
+    const float t = temperature * 1.8f + 32.0f, r = humidity;
+    float hi = 0.5f * (t + 61.0f + (t - 68.0f) * 1.2f + r * 0.094f);
+    if ((hi + t) / 2.0f >= 80.0f) {
+        hi = -42.379f + 2.04901523f * t + 10.14333127f * r - 0.22475541f * t * r - 0.00683783f * t * t - 0.05481717f * r * r + 0.00122874f * t * t * r +
+             0.00085282f * t * r * r - 0.00000199f * t * t * r * r;
+        if (r < 13.0f && t >= 80.0f && t <= 112.0f)
+            hi -= ((13.0f - r) / 4.0f) * sqrtf((17.0f - fabsf(t - 95.0f)) / 17.0f);
+        else if (r > 85.0f && t >= 80.0f && t <= 87.0f)
+            hi += ((r - 85.0f) / 10.0f) * ((87.0f - t) / 5.0f);
+    }
+    hi = (hi - 32.0f) / 1.8f;
+    return hi > temperature ? hi : temperature;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
@@ -20,8 +20,7 @@ float __unpack_f(const uint8_t *x) {
     return u.f;
 }
 
-time_t intervalable(const time_t interval, time_t *last) {
-    time_t now = time(NULL);
+time_t intervalable_at(const time_t interval, time_t *last, const time_t now) {
     if (*last == 0) {
         *last = now;
         return 0;
@@ -33,6 +32,7 @@ time_t intervalable(const time_t interval, time_t *last) {
     }
     return 0;
 }
+time_t intervalable(const time_t interval, time_t *last) { return intervalable_at(interval, last, time(NULL)); }
 
 void hexdump(const unsigned char *data, const int size, const char *prefix) {
     static const int bytes_per_line = 16;
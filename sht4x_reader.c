@@ -1,6 +1,8 @@
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
+#include <ctype.h>
+#include <errno.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -10,6 +12,8 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "include/memory_linux.h"
+#include "include/psychro_linux.h"
 #include "include/util_linux.h"
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
@@ -24,6 +28,12 @@
 #define DEVICE_PATH_DEFAULT "/dev/sht4x"
 #define REPORT_PERIOD_DEFAULT 60
 
+#define REPLAY_SPEED_DEFAULT 0 // as fast as possible
+#define REPLAY_SAMPLE_PERIOD 1 // seconds between raw Trinkey lines, which carry no timestamp
+
+#define SENSOR_LINE_SIZE 256
+#define SENSOR_PAYLOAD_SIZE 512
+
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
@@ -57,36 +67,148 @@ bool mqtt_config(void) {
 typedef struct {
     float temperature;
     float humidity;
+    float dewpoint;
+    float humidity_absolute;
+    float heatindex;
     unsigned long serial;
     time_t timestamp;
 } SensorData;
 
 SensorData sensor_data = {0};
+char sensor_line[SENSOR_LINE_SIZE];
+char sensor_input_buffer[BUFSIZ];
+char sensor_payload[SENSOR_PAYLOAD_SIZE];
+size_t sensor_line_peak = 0, sensor_payload_peak = 0;
 FILE *device_fp = NULL;
 const char *device_path;
 time_t report_period;
 time_t report_last = 0;
 bool debug_mode = false;
 
+const char *replay_path = NULL;
+const char *replay_output = NULL;
+FILE *replay_output_fp = NULL;
+char replay_output_buffer[BUFSIZ];
+int replay_speed;
+time_t replay_start;
+time_t replay_clock = 0;
+bool replay_gated = false;
+bool replay_failed = false;
+
 unsigned long messages_sent = 0;
 unsigned long read_errors = 0;
 time_t start_time = 0;
+volatile bool running = true;
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
-bool sensor_read_line(void) {
-    char line[256];
+void psychro_derive(SensorData *data) {
+    const float vapour = psychro_saturation(data->temperature) * data->humidity / 100.0f;
+    data->dewpoint = psychro_dewpoint(vapour);
+    data->humidity_absolute = psychro_absolute(data->temperature, vapour);
+    data->heatindex = psychro_heatindex(data->temperature, data->humidity);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+// journal line prefix as written by 'journalctl -o short-unix' ("1735990155.123456 host ...") or '-o short-iso' ("2025-01-04T11:29:15+0000
+// host ...", with optional fraction and "+00:00" or "Z" offsets); the default syslog-style prefix carries no year, so is not accepted
+time_t replay_journal_time(const char *line) {
+    char *end;
+    struct tm tm = { 0 };
+    int consumed = 0, hours, minutes;
+    
+    const double unix_time = strtod(line, &end);
+    if (end != line && *end == ' ' && unix_time > 0.0)
+        return (time_t)unix_time;
+    if (sscanf(line, "%4d-%2d-%2dT%2d:%2d:%2d%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &consumed) != 6)
+        return 0;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    time_t result = timegm(&tm);
+    line += consumed;
+    if (*line == '.')
+        while (isdigit((unsigned char)*++line))
+            ;
+    if (*line == 'Z')
+        return result;
+    const int sign = *line == '+' ? 1 : *line == '-' ? -1 : 0;
+    if (sign == 0 || sscanf(++line, "%2d%n", &hours, &consumed) != 1)
+        return 0;
+    line += consumed;
+    if (*line == ':')
+        line++;
+    if (sscanf(line, "%2d", &minutes) != 1)
+        return 0;
+    return result - (time_t)(sign * (hours * 3600 + minutes * 60));
+}
+
+// accepts the Trinkey's raw output ("serial, temperature, humidity, touch") and, when replaying, this reader's own log line as captured
+// by the journal ("SHT4x: serial=..., temperature=...C, humidity=...%, ..., timestamp=..."); the logged timestamp, or failing that the
+// journal's own, is returned in 'logged' (0 for raw lines), and 'gated' marks journal lines as already past the report-period gate
+bool sensor_parse_line(const char *line, time_t *logged, bool *gated) {
     int touch;
+    const char *entry, *stamp;
+    
+    *logged = 0;
+    *gated = false;
+    if (sscanf(line, "%lu, %f, %f, %d", &sensor_data.serial, &sensor_data.temperature, &sensor_data.humidity, &touch) == 4)
+        return true;
+    if (replay_path == NULL || (entry = strstr(line, "SHT4x: serial=")) == NULL)
+        return false;
+    if (sscanf(entry, "SHT4x: serial=%lu, temperature=%fC, humidity=%f%%", &sensor_data.serial, &sensor_data.temperature, &sensor_data.humidity) != 3)
+        return false;
+    if ((stamp = strstr(entry, "timestamp=")) != NULL)
+        *logged = (time_t)strtol(stamp + 10, NULL, 10);
+    else
+        *logged = replay_journal_time(line);
+    *gated = true;
+    return true;
+}
+
+// journal lines carry their own time; raw lines are stamped REPLAY_SAMPLE_PERIOD apart from replay-start, which they require
+time_t replay_timestamp(const time_t logged, const bool gated) {
+    if (gated) {
+        if (logged <= 0) {
+            fprintf(stderr, "replay: journal line without a timestamp, export with 'journalctl -o short-unix'\n");
+            return 0;
+        }
+        replay_clock = logged;
+    } else {
+        if (replay_start <= 0) {
+            fprintf(stderr, "replay: raw capture has no timestamps, --replay-start=<epoch> is required\n");
+            return 0;
+        }
+        replay_clock = replay_clock == 0 ? replay_start : replay_clock + REPLAY_SAMPLE_PERIOD;
+    }
+    return replay_clock;
+}
+
+bool sensor_read_line(void) {
+    time_t logged;
+    bool gated;
     
     if (device_fp == NULL)
         return false;
     
-    while (fgets(line, sizeof(line), device_fp)) {
-        if (line[0] == '#')
+    while (fgets(sensor_line, sizeof(sensor_line), device_fp)) {
+        const size_t length = strlen(sensor_line);
+        if (length > sensor_line_peak)
+            sensor_line_peak = length;
+        if (sensor_line[0] == '#')
             continue;
-        if (sscanf(line, "%lu, %f, %f, %d", &sensor_data.serial, &sensor_data.temperature, &sensor_data.humidity, &touch) == 4) {
-            sensor_data.timestamp = time(NULL);
+        if (sensor_parse_line(sensor_line, &logged, &gated)) {
+            if (replay_path != NULL) {
+                if ((sensor_data.timestamp = replay_timestamp(logged, gated)) == 0) {
+                    replay_failed = true;
+                    return false;
+                }
+                replay_gated = gated;
+            } else
+                sensor_data.timestamp = time(NULL);
+            psychro_derive(&sensor_data);
             return true;
         }
     }
@@ -95,40 +217,54 @@ bool sensor_read_line(void) {
 }
 
 bool sensor_send_mqtt(void) {
-    char json_buffer[512];
     char timestamp_str[32];
     
     struct tm *tm_info = gmtime(&sensor_data.timestamp);
     strftime(timestamp_str, sizeof(timestamp_str), "%Y-%m-%dT%H:%M:%SZ", tm_info);
     
-    snprintf(json_buffer, sizeof(json_buffer),
-             "{\"temperature\":%.2f,\"humidity\":%.2f,\"timestamp\":\"%s\"}",
+    const int length = snprintf(sensor_payload, sizeof(sensor_payload),
+             "{\"temperature\":%.2f,\"humidity\":%.2f,\"dewpoint\":%.2f,\"humidity_absolute\":%.2f,\"heatindex\":%.2f,\"timestamp\":\"%s\"}",
              sensor_data.temperature,
              sensor_data.humidity,
+             sensor_data.dewpoint,
+             sensor_data.humidity_absolute,
+             sensor_data.heatindex,
              timestamp_str);
+    if (length < 0 || (size_t)length >= sizeof(sensor_payload))
+        return false;
+    if ((size_t)length > sensor_payload_peak)
+        sensor_payload_peak = (size_t)length;
     
     if (debug_mode)
-        printf("sensor: sending MQTT message: %s\n", json_buffer);
+        printf("sensor: sending MQTT message: %s\n", sensor_payload);
+    
+    if (replay_output_fp != NULL) {
+        if (fprintf(replay_output_fp, "%s\n", sensor_payload) < 0)
+            return false;
+        messages_sent++;
+        return true;
+    }
     
-    mqtt_send(mqtt_topic, json_buffer, (int) strlen(json_buffer));
+    // replayed data is historical, so must not displace the live retained value
+    const memory_scope_t scope = memory_scope_set(MEMORY_SCOPE_LIBRARY);
+    const bool sent = mqtt_publish(mqtt_topic, sensor_payload, length, replay_path != NULL ? false : MQTT_PUBLISH_RETAIN);
+    memory_scope_set(scope);
+    if (!sent)
+        return false;
     messages_sent++;
     
     return true;
 }
 
-bool sensor_process(void) {
-
-    if (!sensor_read_line()) {
-        read_errors++;
-        fprintf(stderr, "sensor: failed to read from device (errors=%lu)\n", read_errors);
-        return false;
-    }
-    
-    if (intervalable(report_period, &report_last)) {
-        printf("SHT4x: serial=%lu, temperature=%.2fC, humidity=%.2f%%, timestamp=%ld\n",
+bool sensor_report(const bool gate) {
+    if (!gate || intervalable_at(report_period, &report_last, sensor_data.timestamp)) {
+        printf("SHT4x: serial=%lu, temperature=%.2fC, humidity=%.2f%%, dewpoint=%.2fC, humidity_absolute=%.2fg/m3, heatindex=%.2fC, timestamp=%ld\n",
                sensor_data.serial,
                sensor_data.temperature,
                sensor_data.humidity,
+               sensor_data.dewpoint,
+               sensor_data.humidity_absolute,
+               sensor_data.heatindex,
                sensor_data.timestamp);
         
         if (!sensor_send_mqtt()) {
@@ -136,12 +272,26 @@ bool sensor_process(void) {
             return false;
         }
         
-        printf("sensor: MQTT message sent to '%s' (total=%lu)\n", mqtt_topic, messages_sent);
+        if (replay_output_fp != NULL)
+            printf("sensor: message written to '%s' (total=%lu)\n", replay_output, messages_sent);
+        else
+            printf("sensor: MQTT message sent to '%s' (total=%lu)\n", mqtt_topic, messages_sent);
     }
     
     return true;
 }
 
+bool sensor_process(void) {
+
+    if (!sensor_read_line()) {
+        read_errors++;
+        fprintf(stderr, "sensor: failed to read from device (errors=%lu)\n", read_errors);
+        return false;
+    }
+    
+    return sensor_report(true);
+}
+
 bool sensor_stats(void) {
     time_t now = time(NULL), uptime = now - start_time;
     
@@ -149,7 +299,17 @@ bool sensor_stats(void) {
            uptime,
            messages_sent,
            read_errors,
-           messages_sent > 0 ? (float)messages_sent / ((float) uptime / 60.0f) : 0.0f);
+           messages_sent > 0 && uptime > 0 ? (float)messages_sent / ((float) uptime / 60.0f) : 0.0f);
+    printf("stats: rss=%ldkB, config=%d/%d, line=%zu/%zu, payload=%zu/%zu",
+           memory_rss_kb(),
+           config_entry_count, CONFIG_MAX_ENTRIES,
+           sensor_line_peak, sizeof(sensor_line),
+           sensor_payload_peak, sizeof(sensor_payload));
+#ifdef STATIC_MEMORY
+    printf(", allocations=%lu, allocations_mqtt=%lu (libmosquitto, outside static memory)", memory_allocations_get(MEMORY_SCOPE_LOOP),
+           memory_allocations_get(MEMORY_SCOPE_LIBRARY));
+#endif
+    printf("\n");
     
     return true;
 }
@@ -158,7 +318,7 @@ bool sensor_stats(void) {
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
 bool sensor_config(void) {
-    device_path = config_get_string("device-path", DEVICE_PATH_DEFAULT);
+    device_path = replay_path != NULL ? replay_path : config_get_string("device-path", DEVICE_PATH_DEFAULT);
     report_period = (time_t)config_get_integer("report-period", REPORT_PERIOD_DEFAULT);
     debug_mode = config_get_bool("debug", false);
     
@@ -167,6 +327,118 @@ bool sensor_config(void) {
     return true;
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+// replay pushes a captured tty log or journal through the same parse/report/encode path, using sample time rather than wall time, paced
+// at replay-speed times real time (0 for unthrottled), to MQTT (not retained) or to replay-output; it serves as backfill and benchmark;
+// journal lines were gated when logged so are all published, raw lines are gated by report-period starting with the first
+
+// epoch seconds as a time_t, not through config_get_integer, whose int would not hold dates beyond 2038
+bool replay_config_start(const char *value) {
+    char *end;
+    if (value == NULL) {
+        replay_start = 0;
+        return true;
+    }
+    errno = 0;
+    const long long start = strtoll(value, &end, 10);
+    if (!isdigit((unsigned char)*value) || *end != '\0' || errno == ERANGE || start <= 0 || (long long)(time_t)start != start) {
+        fprintf(stderr, "replay: invalid start '%s', expected epoch seconds\n", value);
+        return false;
+    }
+    replay_start = (time_t)start;
+    return true;
+}
+
+bool replay_config(void) {
+    replay_path = config_get_string("replay", NULL);
+    replay_output = config_get_string("replay-output", NULL);
+    replay_speed = config_get_integer("replay-speed", REPLAY_SPEED_DEFAULT);
+    
+    if (replay_path == NULL)
+        return true;
+    if (!replay_config_start(config_get_string("replay-start", NULL)))
+        return false;
+    if (replay_speed < 0) {
+        fprintf(stderr, "replay: invalid speed %d\n", replay_speed);
+        return false;
+    }
+    
+    if (replay_speed > 0)
+        printf("replay: source='%s', output='%s', speed=x%d\n", replay_path, replay_output ? replay_output : mqtt_topic, replay_speed);
+    else
+        printf("replay: source='%s', output='%s', speed=unthrottled\n", replay_path, replay_output ? replay_output : mqtt_topic);
+    
+    return true;
+}
+
+double replay_elapsed(const struct timespec *begin) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - begin->tv_sec) + (double)(now.tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+void replay_pace(const struct timespec *begin, const time_t first) {
+    const double wait = (double)(sensor_data.timestamp - first) / (double)replay_speed - replay_elapsed(begin);
+    if (wait > 0.0) {
+        const struct timespec delay = { .tv_sec = (time_t)wait, .tv_nsec = (long)((wait - (double)(time_t)wait) * 1e9) };
+        nanosleep(&delay, NULL);
+    }
+}
+
+bool replay_begin(void) {
+    if (replay_output != NULL) {
+        replay_output_fp = fopen(replay_output, "w");
+        if (replay_output_fp == NULL) {
+            fprintf(stderr, "replay: cannot open output '%s'\n", replay_output);
+            return false;
+        }
+        setvbuf(replay_output_fp, replay_output_buffer, _IOFBF, sizeof(replay_output_buffer));
+    }
+    return true;
+}
+
+void replay_end(void) {
+    if (replay_output_fp != NULL) {
+        fclose(replay_output_fp);
+        replay_output_fp = NULL;
+    }
+}
+
+bool replay_process(void) {
+    unsigned long samples = 0;
+    time_t first = 0;
+    struct timespec begin;
+    bool result = true;
+    
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    while (running && sensor_read_line()) {
+        if (samples++ == 0) {
+            first = sensor_data.timestamp;
+            report_last = first - report_period - 1;
+        } else if (replay_speed > 0)
+            replay_pace(&begin, first);
+        if (!sensor_report(!replay_gated)) {
+            result = false;
+            break;
+        }
+        memory_scope_set(MEMORY_SCOPE_LOOP);
+    }
+    memory_scope_set(MEMORY_SCOPE_NONE);
+    if (replay_failed)
+        result = false;
+    
+    const double elapsed = replay_elapsed(&begin);
+    printf("replay: samples=%lu, messages=%lu, elapsed=%.3fs, throughput=%.0f samples/s\n",
+           samples,
+           messages_sent,
+           elapsed,
+           elapsed > 0.0 ? (double)samples / elapsed : 0.0);
+    
+    return result;
+}
+
 bool sensor_begin(void) {
     start_time = time(NULL);
     
@@ -175,6 +447,7 @@ bool sensor_begin(void) {
         fprintf(stderr, "sensor: cannot open device '%s'\n", device_path);
         return false;
     }
+    setvbuf(device_fp, sensor_input_buffer, _IOFBF, sizeof(sensor_input_buffer)); // rather than one allocated on first read
     
     printf("sensor: device opened successfully\n");
     return true;
@@ -197,6 +470,10 @@ const struct option config_options[] = {
     {"mqtt-topic", required_argument, 0, 0},
     {"device-path", required_argument, 0, 0},   // sensor
     {"report-period", required_argument, 0, 0},
+    {"replay", required_argument, 0, 0},        // replay
+    {"replay-output", required_argument, 0, 0},
+    {"replay-speed", required_argument, 0, 0},
+    {"replay-start", required_argument, 0, 0},
     {"debug", required_argument, 0, 0},         // debug
     {0, 0, 0, 0}
 };
@@ -205,15 +482,19 @@ bool config(const int argc, const char *argv[]) {
     if (!config_load(CONFIG_FILE_DEFAULT, argc, argv, config_options))
         return false;
     
-    return mqtt_config() && sensor_config();
+    return mqtt_config() && replay_config() && sensor_config();
 }
 
 bool startup(void) {
-    return mqtt_begin(&mqttConfig) && sensor_begin();
+    tzset(); // otherwise loaded lazily by the first gmtime() inside the loop
+    if (replay_path != NULL)
+        return psychro_begin() && replay_begin() && (replay_output != NULL || mqtt_begin(&mqttConfig)) && sensor_begin();
+    return psychro_begin() && mqtt_begin(&mqttConfig) && sensor_begin();
 }
 
 void cleanup(void) {
     sensor_end();
+    replay_end();
     mqtt_end();
 }
 
@@ -234,7 +515,6 @@ bool process(void) {
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
 #define PROCESS_INTERVAL 1  // Check sensor every second
-volatile bool running = true;
 
 void signal_handler(const int sig __attribute__((unused))) {
     if (running) {
@@ -257,9 +537,17 @@ int main(const int argc, const char *argv[]) {
         return EXIT_FAILURE;
     }
     
+    if (replay_path != NULL) {
+        const bool result = replay_process();
+        cleanup();
+        sensor_stats();
+        return result ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
     while (running) {
         if (!process()) {
             // Device disconnected or error - try to recover
+            memory_scope_set(MEMORY_SCOPE_NONE);
             fprintf(stderr, "sensor: attempting recovery\n");
             sensor_end();
             sleep(5);
@@ -271,12 +559,14 @@ int main(const int argc, const char *argv[]) {
             }
             
             printf("sensor: recovery successful\n");
-        }
+        } else
+            memory_scope_set(MEMORY_SCOPE_LOOP); // steady state once a pass has completed
         
         for (int i = 0; i < PROCESS_INTERVAL && running; i++)
             sleep(1);
     }
     
+    memory_scope_set(MEMORY_SCOPE_NONE);
     cleanup();
     sensor_stats();
     return EXIT_SUCCESS;
@@ -0,0 +1,178 @@
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../include/psychro_linux.h"
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+// table-driven psychrometrics against the exact Magnus formulas in double precision, across the SHT4x range (-40..125C, 0..100%RH)
+
+#define CHECK_TEMPERATURE_STEP 0.05
+#define CHECK_HUMIDITY_STEP 0.25
+
+#define CHECK_SATURATION_MAX 0.0005 // relative
+#define CHECK_DEWPOINT_MAX 0.01     // C
+#define CHECK_ABSOLUTE_MAX 0.05     // g/m3
+#define CHECK_HEATINDEX_MAX 0.02    // C
+#define CHECK_HEATINDEX_STEP 1.5    // C, across the NWS selection threshold, where the two forms are themselves up to ~1.3C apart
+#define CHECK_HEATINDEX_NEAR 0.01   // F, selector values this close to 80F may select differently in float and are left to the step check
+
+#define BENCH_SAMPLES 20000000
+#define BENCH_INPUTS 1024
+
+double exact_saturation(const double t) { return 6.112 * exp(17.62 * t / (243.12 + t)); }
+
+double exact_dewpoint(const double vapour) {
+    const double gamma = log(vapour / 6.112);
+    return 243.12 * gamma / (17.62 - gamma);
+}
+
+// NWS selection value: the Steadman simple form averaged with the air temperature, Rothfusz applies from 80F
+double exact_heatindex_selector(const double temperature, const double humidity) {
+    const double t = temperature * 1.8 + 32.0;
+    return (0.5 * (t + 61.0 + (t - 68.0) * 1.2 + humidity * 0.094) + t) / 2.0;
+}
+
+// NWS heat index with the same not-below-air-temperature convention as psychro_heatindex
+double exact_heatindex(const double temperature, const double humidity) {
+    const double t = temperature * 1.8 + 32.0, r = humidity;
+    double hi = 0.5 * (t + 61.0 + (t - 68.0) * 1.2 + r * 0.094);
+    if (exact_heatindex_selector(temperature, humidity) >= 80.0) {
+        hi = -42.379 + 2.04901523 * t + 10.14333127 * r - 0.22475541 * t * r - 0.00683783 * t * t - 0.05481717 * r * r + 0.00122874 * t * t * r +
+             0.00085282 * t * r * r - 0.00000199 * t * t * r * r;
+        if (r < 13.0 && t >= 80.0 && t <= 112.0)
+            hi -= ((13.0 - r) / 4.0) * sqrt((17.0 - fabs(t - 95.0)) / 17.0);
+        else if (r > 85.0 && t >= 80.0 && t <= 87.0)
+            hi += ((r - 85.0) / 10.0) * ((87.0 - t) / 5.0);
+    }
+    hi = (hi - 32.0) / 1.8;
+    return hi > temperature ? hi : temperature;
+}
+
+// largest change in psychro_heatindex across the selection threshold, found by bisection for each humidity
+double check_heatindex_step(void) {
+    double step_max = 0.0;
+    for (int ri = 0; ri <= (int)(100.0 / CHECK_HUMIDITY_STEP); ri++) {
+        const double r = ri * CHECK_HUMIDITY_STEP;
+        double lo = 0.0, hi = 50.0;
+        while (hi - lo > 1e-6)
+            if (exact_heatindex_selector((lo + hi) / 2.0, r) >= 80.0)
+                hi = (lo + hi) / 2.0;
+            else
+                lo = (lo + hi) / 2.0;
+        const double step = fabs((double)psychro_heatindex((float)(hi + 0.001), (float)r) - (double)psychro_heatindex((float)(lo - 0.001), (float)r));
+        if (step > step_max)
+            step_max = step;
+    }
+    return step_max;
+}
+
+bool check_accuracy(void) {
+    double saturation_max = 0.0, dewpoint_max = 0.0, absolute_max = 0.0, heatindex_max = 0.0;
+    unsigned long points = 0;
+
+    for (int ti = 0; ti <= (int)(165.0 / CHECK_TEMPERATURE_STEP); ti++) {
+        const double t = -40.0 + ti * CHECK_TEMPERATURE_STEP, es = exact_saturation(t);
+        const float saturation = psychro_saturation((float)t);
+        const double saturation_error = fabs((double)saturation - es) / es;
+        if (saturation_error > saturation_max)
+            saturation_max = saturation_error;
+        for (int ri = 0; ri <= (int)(100.0 / CHECK_HUMIDITY_STEP); ri++, points++) {
+            const double r = ri * CHECK_HUMIDITY_STEP, e = es * r / 100.0;
+            const float vapour = saturation * (float)r / 100.0f;
+            const double absolute_error = fabs((double)psychro_absolute((float)t, vapour) - 216.7 * e / (t + 273.15));
+            if (absolute_error > absolute_max)
+                absolute_max = absolute_error;
+            if (e > (double)PSYCHRO_VAPOUR_MIN) { // below the floor the exact dew point runs to -inf
+                const double dewpoint_error = fabs((double)psychro_dewpoint(vapour) - exact_dewpoint(e));
+                if (dewpoint_error > dewpoint_max)
+                    dewpoint_max = dewpoint_error;
+            }
+            if (fabs(exact_heatindex_selector(t, r) - 80.0) > CHECK_HEATINDEX_NEAR) {
+                const double heatindex_error = fabs((double)psychro_heatindex((float)t, (float)r) - exact_heatindex(t, r));
+                if (heatindex_error > heatindex_max)
+                    heatindex_max = heatindex_error;
+            }
+        }
+    }
+
+    const double heatindex_step = check_heatindex_step();
+    const bool pass = saturation_max <= CHECK_SATURATION_MAX && dewpoint_max <= CHECK_DEWPOINT_MAX && absolute_max <= CHECK_ABSOLUTE_MAX &&
+                      heatindex_max <= CHECK_HEATINDEX_MAX && heatindex_step <= CHECK_HEATINDEX_STEP;
+    printf("accuracy: points=%lu, saturation=%.4f%% (max %.4f%%), dewpoint=%.4fC (max %.4fC), absolute=%.4fg/m3 (max %.4fg/m3), heatindex=%.4fC (max "
+           "%.4fC), heatindex-step=%.4fC (max %.4fC): %s\n",
+           points,
+           saturation_max * 100.0, CHECK_SATURATION_MAX * 100.0,
+           dewpoint_max, CHECK_DEWPOINT_MAX,
+           absolute_max, CHECK_ABSOLUTE_MAX,
+           heatindex_max, CHECK_HEATINDEX_MAX,
+           heatindex_step, CHECK_HEATINDEX_STEP,
+           pass ? "pass" : "FAIL");
+    return pass;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+float bench_temperature[BENCH_INPUTS], bench_humidity[BENCH_INPUTS];
+volatile float bench_sink;
+
+double bench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+double bench_table(void) {
+    float sink = 0.0f;
+    const double begin = bench_now();
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        const float t = bench_temperature[i % BENCH_INPUTS], r = bench_humidity[i % BENCH_INPUTS];
+        const float vapour = psychro_saturation(t) * r / 100.0f;
+        sink += psychro_dewpoint(vapour) + psychro_absolute(t, vapour);
+    }
+    bench_sink = sink;
+    return (bench_now() - begin) / BENCH_SAMPLES * 1e9;
+}
+
+double bench_exact(void) {
+    float sink = 0.0f;
+    const double begin = bench_now();
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        const float t = bench_temperature[i % BENCH_INPUTS], r = bench_humidity[i % BENCH_INPUTS];
+        const float vapour = PSYCHRO_MAGNUS_E0 * expf(PSYCHRO_MAGNUS_A * t / (PSYCHRO_MAGNUS_B + t)) * r / 100.0f;
+        const float gamma = logf(vapour / PSYCHRO_MAGNUS_E0);
+        sink += PSYCHRO_MAGNUS_B * gamma / (PSYCHRO_MAGNUS_A - gamma) + psychro_absolute(t, vapour);
+    }
+    bench_sink = sink;
+    return (bench_now() - begin) / BENCH_SAMPLES * 1e9;
+}
+
+void check_benchmark(void) {
+    srand(1);
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        bench_temperature[i] = -40.0f + 165.0f * (float)rand() / (float)RAND_MAX;
+        bench_humidity[i] = 1.0f + 99.0f * (float)rand() / (float)RAND_MAX;
+    }
+    const double table = bench_table(), exact = bench_exact();
+    printf("benchmark: table=%.2fns/sample, expf/logf=%.2fns/sample, speedup=%.2fx\n", table, exact, exact / table);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+int main(void) {
+    psychro_begin();
+    const bool pass = check_accuracy();
+    check_benchmark();
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------